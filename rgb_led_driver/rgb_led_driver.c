@@ -27,6 +27,10 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#if RGB_LED_DRV_QUEUE_SIZE < 1 || RGB_LED_DRV_QUEUE_SIZE > UINT16_MAX
+#error "RGB_LED_DRV_QUEUE_SIZE must be in range from 1 to UINT16_MAX."
+#endif
+
 typedef struct _PwmSetDutyCycleFunctions {
     SetPwmDutyCycleFunction set_duty_cycle_r;
     SetPwmDutyCycleFunction set_duty_cycle_g;
@@ -50,8 +54,18 @@ struct RgbLedDrvHandle {
     PwmSetDutyCycleFunctions set_pwm_duty_cycle;
     DutyCycle duty_cycle;
     bool is_turned_on;
+    bool is_queued;
 };
 
+typedef struct _UpdateQueue {
+    RgbLed leds[RGB_LED_DRV_QUEUE_SIZE];
+    uint16_t head;
+    uint16_t count;
+    bool is_enabled;
+    GetTimestampFunction get_timestamp;
+    RgbLedDrvQueueStats stats;
+} UpdateQueue;
+
 static const Rgb color_definitions[RGB_LED_COLOR_CUSTOM] = {
     {255, 0,   0  },
     {0,   255, 0  },
@@ -62,8 +76,13 @@ static const Rgb color_definitions[RGB_LED_COLOR_CUSTOM] = {
     {255, 255, 255},
 };
 
+static UpdateQueue update_queue;
+
 static void  setDutyCycleForAllComponents(RgbLed led, uint8_t duty_cycle);
 static uint8_t convertRgbComponentValueToDutyCycle(uint8_t component, RgbLedCfg cfg);
+static void writeState(RgbLed led);
+static void commitState(RgbLed led);
+static void removeFromQueue(RgbLed led);
 
 static void setDutyCycleForAllComponents(RgbLed led, uint8_t duty_cycle) {
     led->set_pwm_duty_cycle.set_duty_cycle_r(duty_cycle);
@@ -81,6 +100,67 @@ static uint8_t convertRgbComponentValueToDutyCycle(uint8_t component, RgbLedCfg
     return duty_cycle; 
 }
 
+static void writeState(RgbLed led) {
+    if (led->is_turned_on) {
+        led->set_pwm_duty_cycle.set_duty_cycle_r(led->duty_cycle.r);
+        led->set_pwm_duty_cycle.set_duty_cycle_g(led->duty_cycle.g);
+        led->set_pwm_duty_cycle.set_duty_cycle_b(led->duty_cycle.b);
+    } else {
+        uint8_t led_inactive_duty_cycle = RGB_LED_CFG_COMM_CATHODE == led->cfg ? 0 : 100;
+        setDutyCycleForAllComponents(led, led_inactive_duty_cycle);
+    }
+}
+
+static void commitState(RgbLed led) {
+    if (!update_queue.is_enabled) {
+        writeState(led);
+        return;
+    }
+
+    if (led->is_queued) {
+        /* Pending entry will pick up the latest state when drained. */
+        update_queue.stats.coalesced++;
+        return;
+    }
+
+    if (update_queue.count >= RGB_LED_DRV_QUEUE_SIZE) {
+        update_queue.stats.overflows++;
+        writeState(led);
+        return;
+    }
+
+    uint16_t tail = (update_queue.head + update_queue.count) % RGB_LED_DRV_QUEUE_SIZE;
+    update_queue.leds[tail] = led;
+    update_queue.count++;
+    led->is_queued = true;
+
+    if (update_queue.count > update_queue.stats.max_depth) {
+        update_queue.stats.max_depth = update_queue.count;
+    }
+}
+
+static void removeFromQueue(RgbLed led) {
+    uint16_t i;
+
+    for (i = 0; i < update_queue.count; ++i) {
+        if (update_queue.leds[(update_queue.head + i) % RGB_LED_DRV_QUEUE_SIZE] == led) {
+            break;
+        }
+    }
+
+    /* Shift the remaining entries to keep the queue order. */
+    for (; i + 1 < update_queue.count; ++i) {
+        update_queue.leds[(update_queue.head + i) % RGB_LED_DRV_QUEUE_SIZE] =
+            update_queue.leds[(update_queue.head + i + 1) % RGB_LED_DRV_QUEUE_SIZE];
+    }
+
+    if (i < update_queue.count) {
+        update_queue.count--;
+    }
+
+    led->is_queued = false;
+}
+
 RgbLed RgbLedDrv_create(SetPwmDutyCycleFunction set_pwm_r, SetPwmDutyCycleFunction set_pwm_g, SetPwmDutyCycleFunction set_pwm_b,
                         RgbLedCfg cfg, RgbLedColor color, uint8_t r, uint8_t g, uint8_t b, bool initial_state) {
     if (NULL == set_pwm_r || NULL == set_pwm_g || NULL == set_pwm_b) {
@@ -116,14 +196,7 @@ RgbLed RgbLedDrv_create(SetPwmDutyCycleFunction set_pwm_r, SetPwmDutyCycleFuncti
         led->set_pwm_duty_cycle.set_duty_cycle_g = set_pwm_g;
         led->set_pwm_duty_cycle.set_duty_cycle_b = set_pwm_b;
         led->duty_cycle = initial_duty_cycle;
-        if (led->is_turned_on) {
-            led->set_pwm_duty_cycle.set_duty_cycle_r(led->duty_cycle.r);
-            led->set_pwm_duty_cycle.set_duty_cycle_g(led->duty_cycle.g);
-            led->set_pwm_duty_cycle.set_duty_cycle_b(led->duty_cycle.b);
-        } else {
-            uint8_t led_inactive_duty_cycle = RGB_LED_CFG_COMM_CATHODE == led->cfg ? 0 : 100;
-            setDutyCycleForAllComponents(led, led_inactive_duty_cycle);
-        }
+        writeState(led);
     } else {
         return RGB_LED_DRV_INVALID_OBJECT;
     }
@@ -132,6 +205,16 @@ RgbLed RgbLedDrv_create(SetPwmDutyCycleFunction set_pwm_r, SetPwmDutyCycleFuncti
 }
 
 void RgbLedDrv_destroy(RgbLed led) {
+    if (RGB_LED_DRV_INVALID_OBJECT == led) {
+        return;
+    }
+
+    RGB_LED_DRV_ENTER_CRITICAL();
+    if (led->is_queued) {
+        removeFromQueue(led);
+    }
+    RGB_LED_DRV_EXIT_CRITICAL();
+
     free(led);
 }
 
@@ -140,10 +223,10 @@ void RgbLedDrv_turnOn(RgbLed led) {
         return;
     }
 
-    led->set_pwm_duty_cycle.set_duty_cycle_r(led->duty_cycle.r);
-    led->set_pwm_duty_cycle.set_duty_cycle_g(led->duty_cycle.g);
-    led->set_pwm_duty_cycle.set_duty_cycle_b(led->duty_cycle.b);
+    RGB_LED_DRV_ENTER_CRITICAL();
     led->is_turned_on = true;
+    commitState(led);
+    RGB_LED_DRV_EXIT_CRITICAL();
 }
 
 void RgbLedDrv_turnOff(RgbLed led) {
@@ -151,9 +234,10 @@ void RgbLedDrv_turnOff(RgbLed led) {
         return;
     }
 
-    uint8_t led_inactive_duty_cycle = RGB_LED_CFG_COMM_CATHODE == led->cfg ? 0 : 100;
-    setDutyCycleForAllComponents(led, led_inactive_duty_cycle);
+    RGB_LED_DRV_ENTER_CRITICAL();
     led->is_turned_on = false;
+    commitState(led);
+    RGB_LED_DRV_EXIT_CRITICAL();
 }
 
 void RgbLedDrv_setPredefinedColor(RgbLed led, RgbLedColor color) {
@@ -165,15 +249,17 @@ void RgbLedDrv_setPredefinedColor(RgbLed led, RgbLedColor color) {
         return;
     }
 
-    led->duty_cycle.r = convertRgbComponentValueToDutyCycle(color_definitions[color].r, led->cfg);
-    led->duty_cycle.g = convertRgbComponentValueToDutyCycle(color_definitions[color].g, led->cfg);
-    led->duty_cycle.b = convertRgbComponentValueToDutyCycle(color_definitions[color].b, led->cfg);
+    DutyCycle duty_cycle;
+    duty_cycle.r = convertRgbComponentValueToDutyCycle(color_definitions[color].r, led->cfg);
+    duty_cycle.g = convertRgbComponentValueToDutyCycle(color_definitions[color].g, led->cfg);
+    duty_cycle.b = convertRgbComponentValueToDutyCycle(color_definitions[color].b, led->cfg);
 
+    RGB_LED_DRV_ENTER_CRITICAL();
+    led->duty_cycle = duty_cycle;
     if (led->is_turned_on) {
-        led->set_pwm_duty_cycle.set_duty_cycle_r(led->duty_cycle.r);
-        led->set_pwm_duty_cycle.set_duty_cycle_g(led->duty_cycle.g);
-        led->set_pwm_duty_cycle.set_duty_cycle_b(led->duty_cycle.b);
+        commitState(led);
     }
+    RGB_LED_DRV_EXIT_CRITICAL();
 }
 
 void RgbLedDrv_setCustomColor(RgbLed led, uint8_t r, uint8_t g, uint8_t b) {
@@ -181,13 +267,91 @@ void RgbLedDrv_setCustomColor(RgbLed led, uint8_t r, uint8_t g, uint8_t b) {
         return;
     }
 
-    led->duty_cycle.r = convertRgbComponentValueToDutyCycle(r, led->cfg);
-    led->duty_cycle.g = convertRgbComponentValueToDutyCycle(g, led->cfg);
-    led->duty_cycle.b = convertRgbComponentValueToDutyCycle(b, led->cfg);
+    DutyCycle duty_cycle;
+    duty_cycle.r = convertRgbComponentValueToDutyCycle(r, led->cfg);
+    duty_cycle.g = convertRgbComponentValueToDutyCycle(g, led->cfg);
+    duty_cycle.b = convertRgbComponentValueToDutyCycle(b, led->cfg);
 
+    RGB_LED_DRV_ENTER_CRITICAL();
+    led->duty_cycle = duty_cycle;
     if (led->is_turned_on) {
-        led->set_pwm_duty_cycle.set_duty_cycle_r(led->duty_cycle.r);
-        led->set_pwm_duty_cycle.set_duty_cycle_g(led->duty_cycle.g);
-        led->set_pwm_duty_cycle.set_duty_cycle_b(led->duty_cycle.b);
+        commitState(led);
+    }
+    RGB_LED_DRV_EXIT_CRITICAL();
+}
+
+void RgbLedDrv_enableQueuedMode(GetTimestampFunction get_timestamp) {
+    RGB_LED_DRV_ENTER_CRITICAL();
+    update_queue.is_enabled = true;
+    update_queue.get_timestamp = get_timestamp;
+    update_queue.stats = (RgbLedDrvQueueStats){0};
+    update_queue.stats.max_depth = update_queue.count;
+    RGB_LED_DRV_EXIT_CRITICAL();
+}
+
+void RgbLedDrv_disableQueuedMode(void) {
+    RGB_LED_DRV_ENTER_CRITICAL();
+    bool was_enabled = update_queue.is_enabled;
+    update_queue.is_enabled = false;
+    RGB_LED_DRV_EXIT_CRITICAL();
+
+    if (!was_enabled) {
+        return;
+    }
+
+    /* Nothing is queued after disabling and the queue never holds more than RGB_LED_DRV_QUEUE_SIZE entries,
+       so this empties it. */
+    RgbLedDrv_drainQueue(RGB_LED_DRV_QUEUE_SIZE);
+}
+
+uint16_t RgbLedDrv_drainQueue(uint16_t max_updates) {
+    GetTimestampFunction get_timestamp = update_queue.get_timestamp;
+    uint32_t start = get_timestamp ? get_timestamp() : 0;
+    uint16_t updated = 0;
+
+    while (updated < max_updates) {
+        /* Dequeue and write under one critical section, so the LED state cannot change in between. */
+        RGB_LED_DRV_ENTER_CRITICAL();
+        bool is_empty = 0 == update_queue.count;
+
+        if (!is_empty) {
+            RgbLed led = update_queue.leds[update_queue.head];
+            update_queue.head = (update_queue.head + 1) % RGB_LED_DRV_QUEUE_SIZE;
+            update_queue.count--;
+            led->is_queued = false;
+            writeState(led);
+            updated++;
+        }
+        RGB_LED_DRV_EXIT_CRITICAL();
+
+        if (is_empty) {
+            break;
+        }
     }
+
+    /* Empty drains are not measured, so the stats reflect only drains that did some work. */
+    if (get_timestamp && updated > 0) {
+        uint32_t drain_time = get_timestamp() - start;
+
+        RGB_LED_DRV_ENTER_CRITICAL();
+        update_queue.stats.last_drain_time = drain_time;
+
+        if (drain_time > update_queue.stats.max_drain_time) {
+            update_queue.stats.max_drain_time = drain_time;
+        }
+        RGB_LED_DRV_EXIT_CRITICAL();
+    }
+
+    return updated;
+}
+
+void RgbLedDrv_getQueueStats(RgbLedDrvQueueStats *stats) {
+    if (NULL == stats) {
+        return;
+    }
+
+    RGB_LED_DRV_ENTER_CRITICAL();
+    *stats = update_queue.stats;
+    stats->depth = update_queue.count;
+    RGB_LED_DRV_EXIT_CRITICAL();
 }
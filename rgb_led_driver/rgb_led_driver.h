@@ -45,6 +45,34 @@ extern "C" {
 
 #define RGB_LED_DRV_INVALID_OBJECT NULL
 
+/**
+ * @brief Capacity of the update queue used in queued mode (see @a RgbLedDrv_enableQueuedMode()).
+ *
+ * @details The queue holds at most one entry per LED, so there is no benefit in making it larger
+ *          than the number of LEDs in the system. May be overridden at compile time with a value
+ *          from 1 to UINT16_MAX.
+ */
+#ifndef RGB_LED_DRV_QUEUE_SIZE
+#define RGB_LED_DRV_QUEUE_SIZE 16
+#endif
+
+/**
+ * @brief Enter and exit critical section protecting LED state and the update queue.
+ *
+ * @details Empty by default. Override both at compile time when LED updates and @a RgbLedDrv_drainQueue()
+ *          are called from contexts which can preempt each other, e.g. with a function disabling interrupts
+ *          or locking a mutex. The driver always uses them in pairs within the same block and never nests them,
+ *          so @a RGB_LED_DRV_ENTER_CRITICAL() may declare a local variable, e.g. an interrupt lock key.
+ *          A critical section covers at most one LED update (three PWM duty cycle writes).
+ */
+#ifndef RGB_LED_DRV_ENTER_CRITICAL
+#define RGB_LED_DRV_ENTER_CRITICAL()
+#endif
+
+#ifndef RGB_LED_DRV_EXIT_CRITICAL
+#define RGB_LED_DRV_EXIT_CRITICAL()
+#endif
+
 /**
  * @brief RGB LED object. Stores state of an LED.
  */
@@ -58,6 +86,14 @@ typedef struct RgbLedDrvHandle* RgbLed;
  */
 typedef void (*SetPwmDutyCycleFunction)(uint8_t);
 
+/**
+ * @brief Pointer to function returning current timestamp.
+ *
+ * @details Used only for measuring drain time in queued mode. The unit (ticks, microseconds, cycles)
+ *          is up to the user; the driver reports drain time in the same unit. Wrap-around is handled.
+ */
+typedef uint32_t (*GetTimestampFunction)(void);
+
 /**
  * @brief Pre-defined RGB LED colors.
  */
@@ -83,6 +119,18 @@ typedef enum _RgbLedCfg {
     RGB_LED_CFG_COMM_CATHODE
 } RgbLedCfg;
 
+/**
+ * @brief Queued mode statistics. Used to tune the drain budget against the tick period.
+ */
+typedef struct _RgbLedDrvQueueStats {
+    uint16_t depth;           /**< Number of LEDs currently waiting for update. */
+    uint16_t max_depth;       /**< Highest depth observed since queued mode was enabled. */
+    uint32_t coalesced;       /**< Number of updates merged into an already queued entry. */
+    uint32_t overflows;       /**< Number of updates written synchronously because the queue was full. */
+    uint32_t last_drain_time; /**< Duration of the most recent @a RgbLedDrv_drainQueue() call which updated any LED. */
+    uint32_t max_drain_time;  /**< Longest @a RgbLedDrv_drainQueue() call observed. */
+} RgbLedDrvQueueStats;
+
 /**
  * @brief Create a new RgbLed object.
  * 
@@ -115,6 +163,8 @@ RgbLed RgbLedDrv_create(SetPwmDutyCycleFunction set_pwm_r, SetPwmDutyCycleFuncti
 /**
  * @brief Destroy the RgbLed object.
  * 
+ * @details If @p led has a pending update in queued mode, the update is discarded.
+ *
  * @param led Valid RgbLed object. After calling this function @p led is set to RGB_LED_DRV_INVALID_OBJECT.
  *            This function has no effect if @p led is RGB_LED_DRV_INVALID_OBJECT.
  */
@@ -166,6 +216,52 @@ void RgbLedDrv_setPredefinedColor(RgbLed led, RgbLedColor color);
  */
 void RgbLedDrv_setCustomColor(RgbLed led, uint8_t r, uint8_t g, uint8_t b);
 
+/**
+ * @brief Enable queued mode for all RgbLed objects.
+ *
+ * @details In queued mode @a RgbLedDrv_turnOn(), @a RgbLedDrv_turnOff(), @a RgbLedDrv_setPredefinedColor(),
+ *          and @a RgbLedDrv_setCustomColor() only update the LED state and put the LED in a fixed-size queue.
+ *          No PWM duty cycle is set until @a RgbLedDrv_drainQueue() is called. Repeated updates of an LED which
+ *          is already queued are merged, so only its latest state is written. If the queue is full, the update
+ *          is written synchronously, as in direct mode. @a RgbLedDrv_create() is not affected by queued mode;
+ *          it always sets the initial duty cycles synchronously.
+ *          If updates and drains are called from different contexts (e.g. a thread and a timer ISR),
+ *          define @a RGB_LED_DRV_ENTER_CRITICAL() and @a RGB_LED_DRV_EXIT_CRITICAL().
+ *          Calling this function when queued mode is already enabled only resets statistics and timestamp function.
+ *
+ * @param get_timestamp Pointer to the function used to measure drain time. May be NULL; then drain time is reported as 0.
+ */
+void RgbLedDrv_enableQueuedMode(GetTimestampFunction get_timestamp);
+
+/**
+ * @brief Disable queued mode.
+ *
+ * @details All pending updates are written before returning, and subsequent updates are written synchronously.
+ *          This function has no effect when queued mode is not enabled.
+ */
+void RgbLedDrv_disableQueuedMode(void);
+
+/**
+ * @brief Write pending updates.
+ *
+ * @details LEDs are updated in the order they were queued. An LED updated again after being drained
+ *          goes to the back of the queue, so no LED waits for longer than one full pass over the queue.
+ *          Each LED update sets duty cycle of all three PWM pins.
+ *
+ * @param max_updates Maximum number of LEDs to update in this call. If set to 0, nothing is written.
+ *                    Pass RGB_LED_DRV_QUEUE_SIZE to write all pending updates.
+ *
+ * @return number of LEDs updated.
+ */
+uint16_t RgbLedDrv_drainQueue(uint16_t max_updates);
+
+/**
+ * @brief Get queued mode statistics.
+ *
+ * @param stats Pointer to the structure to fill. This function has no effect if @p stats is NULL.
+ */
+void RgbLedDrv_getQueueStats(RgbLedDrvQueueStats *stats);
+
 #ifdef __cplusplus
 }
 #endif